@@ -4,6 +4,7 @@
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <math.h>
 
 #define LOGGER_LEVEL_INFO
 #define LOGGER_LEVEL_ERROR
@@ -23,6 +24,11 @@ static HWND WindowCreate(
     int width  = CW_USEDEFAULT,
     int height = CW_USEDEFAULT);
 static void WindowCleanup(HWND window);
+static u32 TessellateRect(Vertex *vertices, const RendererRect *rect, u32 segments);
+
+#define TESSELLATION_SEGMENTS 8
+// Fill fan plus border ring over 4 corners of (segments + 1) outline points each
+#define TESSELLATION_MAX_VERTICES(segments) (9 * 4 * ((segments) + 1))
 
 typedef struct
 {
@@ -32,6 +38,9 @@ typedef struct
 
     // INPUT
     struct { float x, y; } mouse;
+
+    // DEBUG
+    bool tessellateRects;
 } Giterme;
 
 static Giterme giterme;
@@ -45,8 +54,10 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE instancePrevious, LPWSTR args,
     Assert(IsWindow(window));
 
     RendererState renderer = RendererInit(window);
-    RendererDrawData drawData =
+    RendererBlock quad =
     {
+        .id = 1,
+        .version = 1,
         .vertexCount = 6,
         .vertices = (Vertex *)VirtualAlloc(
             nullptr,
@@ -54,14 +65,51 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE instancePrevious, LPWSTR args,
             MEM_RESERVE | MEM_COMMIT,
             PAGE_READWRITE),
     };
-    ZeroMemory(drawData.vertices, drawData.vertexCount * sizeof(Vertex));
-    //                                    X      Y             AABBGGRR
-    drawData.vertices[0] = { .pos = { -0.5f, -0.5f }, .col = 0xff0000ff };
-    drawData.vertices[1] = { .pos = { -0.5f,  0.5f }, .col = 0xff00ff00 };
-    drawData.vertices[2] = { .pos = {  0.5f, -0.5f }, .col = 0xffff0000 };
-    drawData.vertices[3] = { .pos = {  0.5f, -0.5f }, .col = 0xffff0000 };
-    drawData.vertices[4] = { .pos = { -0.5f,  0.5f }, .col = 0xff00ff00 };
-    drawData.vertices[5] = { .pos = {  0.5f,  0.5f }, .col = 0xff0000ff };
+    ZeroMemory(quad.vertices, quad.vertexCount * sizeof(Vertex));
+    //                                 X        Y             AABBGGRR
+    quad.vertices[0] = { .pos = { 320.0f, 540.0f }, .col = 0xff0000ff };
+    quad.vertices[1] = { .pos = { 320.0f, 180.0f }, .col = 0xff00ff00 };
+    quad.vertices[2] = { .pos = { 960.0f, 540.0f }, .col = 0xffff0000 };
+    quad.vertices[3] = { .pos = { 960.0f, 540.0f }, .col = 0xffff0000 };
+    quad.vertices[4] = { .pos = { 320.0f, 180.0f }, .col = 0xff00ff00 };
+    quad.vertices[5] = { .pos = { 960.0f, 180.0f }, .col = 0xff0000ff };
+
+    //      X       Y       W       H         RADIUS  BORDER  FILL        BORDER      SHADOW      SOFT    OFFSET
+    RendererRect rects[] =
+    {
+        { { 40.0f,  40.0f,  360.0f, 240.0f }, 12.0f,  1.0f,   0xff2a2a2a, 0xff505050, 0x80000000, 16.0f,  { 0.0f, 6.0f } },
+        { { 64.0f,  200.0f, 140.0f, 36.0f  }, 6.0f,   2.0f,   0xff3070d0, 0xffffffff, 0x00000000, 0.0f,   { 0.0f, 0.0f } },
+        { { 224.0f, 200.0f, 152.0f, 36.0f  }, 18.0f,  0.0f,   0xff50a030, 0x00000000, 0x60000000, 6.0f,   { 0.0f, 2.0f } },
+        { { 64.0f,  72.0f,  312.0f, 104.0f }, 4.0f,   1.0f,   0xff1e1e1e, 0xff3c3c3c, 0x00000000, 0.0f,   { 0.0f, 0.0f } },
+    };
+
+    // NOTE: Same rects as triangles, toggled with F1 to compare against the SDF path.
+    // Shadows are not tessellated, so this undercounts what the SDF path replaces.
+    Vertex *tessellatedVertices = (Vertex *)VirtualAlloc(
+        nullptr,
+        ArrayCount(rects) * TESSELLATION_MAX_VERTICES(TESSELLATION_SEGMENTS) * sizeof(Vertex),
+        MEM_RESERVE | MEM_COMMIT,
+        PAGE_READWRITE);
+    u32 tessellatedVertexCount = 0;
+    for (u32 i = 0; i < ArrayCount(rects); ++i)
+    {
+        tessellatedVertexCount += TessellateRect(tessellatedVertices + tessellatedVertexCount, &rects[i], TESSELLATION_SEGMENTS);
+    }
+
+    RendererDrawData drawData =
+    {
+        .blockCount = 1,
+        .blocks = &quad,
+        .view = { .scroll = { 0.0f, 0.0f }, .zoom = 1.0f },
+    };
+
+    // NOTE: Tessellated rects go through the immediate vertices, which are drawn last by
+    // default. Keep them behind the cached quad like the SDF rects.
+    RendererCommand tessellatedCommands[] =
+    {
+        { RENDERER_COMMAND_VERTICES, 0, tessellatedVertexCount },
+        { RENDERER_COMMAND_BLOCKS,   0, 1 },
+    };
 
     giterme.renderer = &renderer;
     giterme.drawData = &drawData;
@@ -77,6 +125,25 @@ int WINAPI wWinMain(HINSTANCE instance, HINSTANCE instancePrevious, LPWSTR args,
             if (message.message == WM_QUIT) { quit = true; break; }
         }
 
+        if (giterme.tessellateRects)
+        {
+            drawData.rectCount    = 0;
+            drawData.rects        = nullptr;
+            drawData.vertexCount  = tessellatedVertexCount;
+            drawData.vertices     = tessellatedVertices;
+            drawData.commandCount = (u32)ArrayCount(tessellatedCommands);
+            drawData.commands     = tessellatedCommands;
+        }
+        else
+        {
+            drawData.rectCount    = (u32)ArrayCount(rects);
+            drawData.rects        = rects;
+            drawData.vertexCount  = 0;
+            drawData.vertices     = nullptr;
+            drawData.commandCount = 0;
+            drawData.commands     = nullptr;
+        }
+
         RendererDraw(giterme.renderer, giterme.drawData);
     }
 
@@ -102,6 +169,49 @@ static LRESULT CALLBACK WindowProc(HWND window, UINT message, WPARAM wParam, LPA
             giterme.mouse.x = (float)LOWORD(lParam);
             giterme.mouse.y = (float)HIWORD(lParam);
         } break;
+
+        case WM_SIZE:
+        {
+            // NOTE: Also sent from CreateWindowExW(), before the renderer exists.
+            if (giterme.renderer && wParam != SIZE_MINIMIZED)
+            {
+                RendererResize(giterme.renderer, LOWORD(lParam), HIWORD(lParam));
+            }
+        } break;
+
+        case WM_KEYDOWN:
+        {
+            // NOTE: Bit 30 is set on auto-repeat, so holding F1 only toggles once.
+            if (wParam == VK_F1 && !(lParam & (1 << 30)))
+            {
+                giterme.tessellateRects = !giterme.tessellateRects;
+                LogInfo("Drawing rects %s.", giterme.tessellateRects ? "tessellated" : "with SDF");
+            }
+        } break;
+
+        case WM_MOUSEWHEEL:
+        {
+            if (giterme.drawData)
+            {
+                RendererView *view = &giterme.drawData->view;
+                float steps = (float)GET_WHEEL_DELTA_WPARAM(wParam) / (float)WHEEL_DELTA;
+                if (GET_KEYSTATE_WPARAM(wParam) & MK_CONTROL)
+                {
+                    // Zoom around the cursor so the content under it stays put
+                    float zoom = view->zoom * (steps > 0.0f ? 1.1f : 1.0f / 1.1f);
+                    if (zoom < 0.1f) { zoom = 0.1f; }
+                    if (zoom > 10.0f) { zoom = 10.0f; }
+                    view->scroll.x += giterme.mouse.x / view->zoom - giterme.mouse.x / zoom;
+                    view->scroll.y += giterme.mouse.y / view->zoom - giterme.mouse.y / zoom;
+                    view->zoom = zoom;
+                }
+                else
+                {
+                    view->scroll.y -= steps * 40.0f / view->zoom;
+                }
+            }
+            result = 0;
+        } break;
     }
 
     return result;
@@ -146,4 +256,73 @@ static void WindowCleanup(HWND window)
         if (IsWindow(window)) { DestroyWindow(window); }
         window = 0;
     }
-}
\ No newline at end of file
+}
+
+static u32 RoundedRectOutline(Vertex *points, float x0, float y0, float x1, float y1, float radius, u32 segments, u32 color)
+{
+    const float pi = 3.14159265f;
+    float centerX[4] = { x0 + radius, x1 - radius, x1 - radius, x0 + radius };
+    float centerY[4] = { y0 + radius, y0 + radius, y1 - radius, y1 - radius };
+    u32 count = 0;
+    for (u32 corner = 0; corner < 4; ++corner)
+    {
+        for (u32 segment = 0; segment <= segments; ++segment)
+        {
+            float angle = pi * (1.0f + 0.5f * (float)corner) + 0.5f * pi * (float)segment / (float)segments;
+            points[count++] =
+            {
+                .pos = { centerX[corner] + cosf(angle) * radius, centerY[corner] + sinf(angle) * radius },
+                .col = color,
+            };
+        }
+    }
+    return count;
+}
+
+// Writes a triangle list for the rect's fill and border, returns the vertex count.
+static u32 TessellateRect(Vertex *vertices, const RendererRect *rect, u32 segments)
+{
+    Vertex outer[4 * (TESSELLATION_SEGMENTS + 1)];
+    Vertex inner[4 * (TESSELLATION_SEGMENTS + 1)];
+    Assert(segments <= TESSELLATION_SEGMENTS);
+
+    float x0 = rect->rect.x;
+    float y0 = rect->rect.y;
+    float x1 = rect->rect.x + rect->rect.w;
+    float y1 = rect->rect.y + rect->rect.h;
+    float radius = min(rect->radius, 0.5f * min(rect->rect.w, rect->rect.h));
+    float border = rect->borderWidth;
+    float innerRadius = max(radius - border, 0.0f);
+    float innerInset = max(radius, border) - innerRadius;
+
+    u32 pointCount = RoundedRectOutline(inner, x0 + innerInset, y0 + innerInset, x1 - innerInset, y1 - innerInset, innerRadius, segments, rect->fillColor);
+    RoundedRectOutline(outer, x0, y0, x1, y1, radius, segments, rect->borderColor);
+
+    u32 count = 0;
+    Vertex center = { .pos = { 0.5f * (x0 + x1), 0.5f * (y0 + y1) }, .col = rect->fillColor };
+    for (u32 i = 0; i < pointCount; ++i)
+    {
+        u32 next = (i + 1) % pointCount;
+        vertices[count++] = center;
+        vertices[count++] = inner[i];
+        vertices[count++] = inner[next];
+    }
+
+    if (border > 0.0f)
+    {
+        for (u32 i = 0; i < pointCount; ++i)
+        {
+            u32 next = (i + 1) % pointCount;
+            Vertex innerCurrent = { .pos = { inner[i].pos.x,    inner[i].pos.y    }, .col = rect->borderColor };
+            Vertex innerNext    = { .pos = { inner[next].pos.x, inner[next].pos.y }, .col = rect->borderColor };
+            vertices[count++] = outer[i];
+            vertices[count++] = outer[next];
+            vertices[count++] = innerCurrent;
+            vertices[count++] = innerCurrent;
+            vertices[count++] = outer[next];
+            vertices[count++] = innerNext;
+        }
+    }
+
+    return count;
+}
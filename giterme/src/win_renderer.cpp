@@ -5,6 +5,37 @@
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "d3dcompiler.lib")
 
+static void RendererCreateRenderTargetView(RendererState *renderer)
+{
+    ID3D11Texture2D *backBuffer = nullptr;
+    if (FAILED(renderer->swapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer))))
+    {
+        LogError("Could not get backBuffer to create RenderTargetView.");
+        return;
+    }
+    else
+    {
+        LogInfo("Acquired backbuffer.\n"
+            "  + BACKBUFFER: 0x%p",
+            backBuffer);
+    }
+    HRESULT hr = renderer->device->CreateRenderTargetView(backBuffer, 0, &renderer->renderTargetView);
+    if (SUCCEEDED(hr))
+    {
+        LogInfo("Created render target view.\n"
+            "  + RENDERTARGETVIEW: 0x%p",
+            renderer->renderTargetView);
+    }
+    else
+    {
+        LogError("Could not create render target view.");
+    }
+
+    // NOTE: ResizeBuffers() fails while anyone still holds a reference to the back buffer.
+    backBuffer->Release();
+    backBuffer = nullptr;
+}
+
 RendererState RendererInit(HWND window)
 {
     RendererState result = {};
@@ -103,30 +134,7 @@ RendererState RendererInit(HWND window)
     #endif
 
     // Init render target view
-    {
-        ID3D11Texture2D *backBuffer = nullptr;
-        if (FAILED(result.swapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer))))
-        {
-            LogError("Could not get backBuffer to create RenderTargetView.");
-        }
-        else
-        {
-            LogInfo("Acquired backbuffer.\n"
-                "  + BACKBUFFER: 0x%p",
-                backBuffer);
-        }
-        hr = result.device->CreateRenderTargetView(backBuffer, 0, &result.renderTargetView);
-        if (SUCCEEDED(hr))
-        {
-            LogInfo("Created render target view.\n"
-                "  + RENDERTARGETVIEW: 0x%p",
-                result.renderTargetView);
-        }
-        else
-        {
-            LogError("Could not create render target view.");
-        }
-    }
+    RendererCreateRenderTargetView(&result);
 
     // Vertex shader stuff
     {
@@ -142,10 +150,18 @@ RendererState RendererInit(HWND window)
                 float4 position : SV_POSITION;\
                 float4 color : COL;\
             };\
+            cbuffer View : register(b0)\
+            {\
+                float2 screenSize;\
+                float2 scroll;\
+                float zoom;\
+            };\
             PS_Input vs_main(VS_Input input)\
             {\
                 PS_Input output;\
-                output.position = float4(input.pos, 0.0f, 1.0f);\
+                float2 pixel = (input.pos - scroll) * zoom;\
+                float2 ndc = pixel / screenSize * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f);\
+                output.position = float4(ndc, 0.0f, 1.0f);\
                 output.color = input.color;    \
                 return output;\
             }";
@@ -241,7 +257,7 @@ RendererState RendererInit(HWND window)
             };\
             float4 ps_main(PS_Input input) : SV_TARGET\
             {\
-                return input.color;\
+                return float4(input.color.rgb * input.color.a, input.color.a);\
             }";
         if (D3DCompile(
                 pixelShaderSource,
@@ -297,6 +313,311 @@ RendererState RendererInit(HWND window)
         }
     }
 
+    // Constant buffer stuff
+    {
+        D3D11_BUFFER_DESC constantBufferDesc =
+        {
+            .ByteWidth = (UINT)sizeof(result.constants),
+            .Usage = D3D11_USAGE_DYNAMIC,
+            .BindFlags = D3D11_BIND_CONSTANT_BUFFER,
+            .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE,
+        };
+        hr = result.device->CreateBuffer(&constantBufferDesc, nullptr, &result.constantBuffer);
+        if (SUCCEEDED(hr))
+        {
+            LogInfo("Created constant buffer.\n"
+                "  + CONSTANT_BUFFER: 0x%p",
+                result.constantBuffer);
+        }
+        else
+        {
+            LogError("Could not create constant buffer.");
+        }
+        // NOTE: Zero zoom never matches a real view, so the first draw always uploads.
+        result.constants.zoom = 0.0f;
+    }
+
+    result.cache.budgetBytes = RENDERER_CACHE_BUDGET_BYTES;
+
+    // Blend state stuff (premultiplied alpha, so SDF edges and shadows compose correctly)
+    {
+        D3D11_BLEND_DESC blendDesc = {};
+        blendDesc.RenderTarget[0] =
+        {
+            .BlendEnable = TRUE,
+            .SrcBlend = D3D11_BLEND_ONE,
+            .DestBlend = D3D11_BLEND_INV_SRC_ALPHA,
+            .BlendOp = D3D11_BLEND_OP_ADD,
+            .SrcBlendAlpha = D3D11_BLEND_ONE,
+            .DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA,
+            .BlendOpAlpha = D3D11_BLEND_OP_ADD,
+            .RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL,
+        };
+        hr = result.device->CreateBlendState(&blendDesc, &result.blendState);
+        if (SUCCEEDED(hr))
+        {
+            LogInfo("Created blend state.\n"
+                "  + BLEND_STATE: 0x%p",
+                result.blendState);
+        }
+        else
+        {
+            LogError("Could not create blend state.");
+        }
+    }
+
+    // Rect shader stuff
+    {
+        // NOTE: One instance per RendererRect. The vertex shader expands SV_VertexID into a
+        // quad covering the box plus its shadow, the pixel shader evaluates the rounded box
+        // distance for fill, border and shadow coverage.
+        const char rectShaderSource[] =
+            "cbuffer View : register(b0)\
+            {\
+                float2 screenSize;\
+                float2 scroll;\
+                float zoom;\
+            };\
+            struct VS_Input\
+            {\
+                float4 rect : RECT;\
+                float radius : RADIUS;\
+                float borderWidth : BORDER_WIDTH;\
+                float4 fillColor : FILL_COL;\
+                float4 borderColor : BORDER_COL;\
+                float4 shadowColor : SHADOW_COL;\
+                float shadowSoftness : SHADOW_SOFTNESS;\
+                float2 shadowOffset : SHADOW_OFFSET;\
+                uint vertexId : SV_VertexID;\
+            };\
+            struct PS_Input\
+            {\
+                float4 position : SV_POSITION;\
+                float2 local : LOCAL;\
+                nointerpolation float2 halfSize : HALF_SIZE;\
+                nointerpolation float radius : RADIUS;\
+                nointerpolation float borderWidth : BORDER_WIDTH;\
+                nointerpolation float4 fillColor : FILL_COL;\
+                nointerpolation float4 borderColor : BORDER_COL;\
+                nointerpolation float4 shadowColor : SHADOW_COL;\
+                nointerpolation float shadowSoftness : SHADOW_SOFTNESS;\
+                nointerpolation float2 shadowOffset : SHADOW_OFFSET;\
+            };\
+            PS_Input vs_main(VS_Input input)\
+            {\
+                PS_Input output;\
+                float2 halfSize = input.rect.zw * 0.5f;\
+                float2 center = input.rect.xy + halfSize;\
+                float2 pad = 1.0f / zoom;\
+                if (input.shadowColor.a > 0.0f)\
+                {\
+                    pad += abs(input.shadowOffset) + input.shadowSoftness;\
+                }\
+                float2 corner = float2(input.vertexId & 1, input.vertexId >> 1) * 2.0f - 1.0f;\
+                float2 local = corner * (halfSize + pad);\
+                float2 pixel = (center + local - scroll) * zoom;\
+                float2 ndc = pixel / screenSize * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f);\
+                output.position = float4(ndc, 0.0f, 1.0f);\
+                output.local = local;\
+                output.halfSize = halfSize;\
+                output.radius = min(input.radius, min(halfSize.x, halfSize.y));\
+                output.borderWidth = input.borderWidth;\
+                output.fillColor = input.fillColor;\
+                output.borderColor = input.borderColor;\
+                output.shadowColor = input.shadowColor;\
+                output.shadowSoftness = input.shadowSoftness;\
+                output.shadowOffset = input.shadowOffset;\
+                return output;\
+            }\
+            float RoundedBoxDistance(float2 p, float2 halfSize, float radius)\
+            {\
+                float2 q = abs(p) - halfSize + radius;\
+                return length(max(q, 0.0f)) + min(max(q.x, q.y), 0.0f) - radius;\
+            }\
+            float4 ps_main(PS_Input input) : SV_TARGET\
+            {\
+                float aa = 1.0f / zoom;\
+                float d = RoundedBoxDistance(input.local, input.halfSize, input.radius);\
+                float outer = saturate(0.5f - d / aa);\
+                float inner = saturate(0.5f - (d + input.borderWidth) / aa);\
+                float4 fill = float4(input.fillColor.rgb * input.fillColor.a, input.fillColor.a);\
+                float4 border = float4(input.borderColor.rgb * input.borderColor.a, input.borderColor.a);\
+                float4 box = fill * inner + border * (outer - inner);\
+                float softness = max(input.shadowSoftness, aa);\
+                float s = RoundedBoxDistance(input.local - input.shadowOffset, input.halfSize, input.radius);\
+                float shadowAlpha = input.shadowColor.a * (1.0f - smoothstep(-softness, softness, s));\
+                float4 shadow = float4(input.shadowColor.rgb * shadowAlpha, shadowAlpha);\
+                return box + shadow * (1.0f - box.a);\
+            }";
+
+        ID3DBlob *rectVertexShaderBlob = nullptr;
+        ID3DBlob *rectPixelShaderBlob = nullptr;
+        ID3DBlob *compileErrorsBlob = nullptr;
+        if (D3DCompile(
+                rectShaderSource,
+                strlen(rectShaderSource),
+                nullptr,
+                nullptr,
+                nullptr,
+                "vs_main",
+                "vs_5_0",
+                0,
+                0,
+                &rectVertexShaderBlob,
+                &compileErrorsBlob)
+            != S_OK)
+        {
+            LogError("Could not compile rect vertex shader.\nError message: %s", (char *)compileErrorsBlob->GetBufferPointer());
+            Assert(false);
+        }
+        else
+        {
+            LogInfo("Compiled rect vertex shader.\n"
+                "  + BLOB: 0x%p",
+                rectVertexShaderBlob);
+        }
+        if (compileErrorsBlob)
+        {
+            compileErrorsBlob->Release();
+            compileErrorsBlob = nullptr;
+        }
+        if (D3DCompile(
+                rectShaderSource,
+                strlen(rectShaderSource),
+                nullptr,
+                nullptr,
+                nullptr,
+                "ps_main",
+                "ps_5_0",
+                0,
+                0,
+                &rectPixelShaderBlob,
+                &compileErrorsBlob)
+            != S_OK)
+        {
+            LogError("Could not compile rect pixel shader.\nError message: %s", (char *)compileErrorsBlob->GetBufferPointer());
+            Assert(false);
+        }
+        else
+        {
+            LogInfo("Compiled rect pixel shader.\n"
+                "  + BLOB: 0x%p",
+                rectPixelShaderBlob);
+        }
+        if (compileErrorsBlob)
+        {
+            compileErrorsBlob->Release();
+            compileErrorsBlob = nullptr;
+        }
+
+        hr = result.device->CreateVertexShader(
+            rectVertexShaderBlob->GetBufferPointer(),
+            rectVertexShaderBlob->GetBufferSize(),
+            nullptr,
+            &result.rectVertexShader);
+        if (SUCCEEDED(hr))
+        {
+            LogInfo("Created rect vertex shader.\n"
+                "  + RECT_VERTEX_SHADER: 0x%p",
+                result.rectVertexShader);
+        }
+        else
+        {
+            LogError("Could not create rect vertex shader.");
+        }
+
+        hr = result.device->CreatePixelShader(
+            rectPixelShaderBlob->GetBufferPointer(),
+            rectPixelShaderBlob->GetBufferSize(),
+            nullptr,
+            &result.rectPixelShader);
+        if (SUCCEEDED(hr))
+        {
+            LogInfo("Created rect pixel shader.\n"
+                "  + RECT_PIXEL_SHADER: 0x%p",
+                result.rectPixelShader);
+        }
+        else
+        {
+            LogError("Could not create rect pixel shader.");
+        }
+
+        // Create input layout
+        {
+            D3D11_INPUT_ELEMENT_DESC localLayout[] =
+            {
+                { "RECT",            0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, (UINT)offsetof(RendererRect, rect),           D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "RADIUS",          0, DXGI_FORMAT_R32_FLOAT,          0, (UINT)offsetof(RendererRect, radius),         D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "BORDER_WIDTH",    0, DXGI_FORMAT_R32_FLOAT,          0, (UINT)offsetof(RendererRect, borderWidth),    D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "FILL_COL",        0, DXGI_FORMAT_R8G8B8A8_UNORM,     0, (UINT)offsetof(RendererRect, fillColor),      D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "BORDER_COL",      0, DXGI_FORMAT_R8G8B8A8_UNORM,     0, (UINT)offsetof(RendererRect, borderColor),    D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "SHADOW_COL",      0, DXGI_FORMAT_R8G8B8A8_UNORM,     0, (UINT)offsetof(RendererRect, shadowColor),    D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "SHADOW_SOFTNESS", 0, DXGI_FORMAT_R32_FLOAT,          0, (UINT)offsetof(RendererRect, shadowSoftness), D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+                { "SHADOW_OFFSET",   0, DXGI_FORMAT_R32G32_FLOAT,       0, (UINT)offsetof(RendererRect, shadowOffset),   D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            };
+            hr = result.device->CreateInputLayout(
+                localLayout,
+                (UINT)ArrayCount(localLayout),
+                rectVertexShaderBlob->GetBufferPointer(),
+                rectVertexShaderBlob->GetBufferSize(),
+                &result.rectInputLayout);
+            if (SUCCEEDED(hr))
+            {
+                LogInfo("Created rect input layout.\n"
+                    "  + RECT_INPUT_LAYOUT: 0x%p",
+                    result.rectInputLayout);
+            }
+            else
+            {
+                LogError("Could not create rect input layout.");
+            }
+        }
+
+        rectVertexShaderBlob->Release();
+        rectVertexShaderBlob = nullptr;
+        rectPixelShaderBlob->Release();
+        rectPixelShaderBlob = nullptr;
+        LogInfo("Released rect shader blobs.");
+    }
+
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceFrequency(&frequency);
+    result.ticksPerSecond = (u64)frequency.QuadPart;
+
+    // GPU timer queries, one set per frame in flight
+    {
+        D3D11_QUERY_DESC disjointDesc = { .Query = D3D11_QUERY_TIMESTAMP_DISJOINT };
+        D3D11_QUERY_DESC timestampDesc = { .Query = D3D11_QUERY_TIMESTAMP };
+        bool created = true;
+        for (u32 i = 0; i < RENDERER_GPU_TIMER_FRAMES; ++i)
+        {
+            RendererGpuTimer *timer = &result.gpuTimers[i];
+            created &= SUCCEEDED(result.device->CreateQuery(&disjointDesc, &timer->disjoint));
+            for (u32 j = 0; j < ArrayCount(timer->timestamps); ++j)
+            {
+                created &= SUCCEEDED(result.device->CreateQuery(&timestampDesc, &timer->timestamps[j]));
+            }
+        }
+        if (created)
+        {
+            LogInfo("Created GPU timer queries.");
+        }
+        else
+        {
+            // NOTE: A null disjoint query turns timing off in RendererDraw().
+            LogError("Could not create GPU timer queries.");
+            for (u32 i = 0; i < RENDERER_GPU_TIMER_FRAMES; ++i)
+            {
+                RendererGpuTimer *timer = &result.gpuTimers[i];
+                if (timer->disjoint) { timer->disjoint->Release(); timer->disjoint = nullptr; }
+                for (u32 j = 0; j < ArrayCount(timer->timestamps); ++j)
+                {
+                    if (timer->timestamps[j]) { timer->timestamps[j]->Release(); timer->timestamps[j] = nullptr; }
+                }
+            }
+        }
+    }
+
     LogInfo("INIT RESULT:\n"
         "  + DEVICE:             0x%p\n"
         "  + CONTEXT:            0x%p\n"
@@ -305,7 +626,12 @@ RendererState RendererInit(HWND window)
         "  + VERTEX_SHADER:      0x%p\n"
         "  + PIXEL_SHADER:       0x%p\n"
         "  + RENDER_TARGET_VIEW: 0x%p\n"
-        "  + VERTEX_BUFFER:      0x%p",
+        "  + VERTEX_BUFFER:      0x%p\n"
+        "  + CONSTANT_BUFFER:    0x%p\n"
+        "  + BLEND_STATE:        0x%p\n"
+        "  + RECT_INPUT_LAYOUT:  0x%p\n"
+        "  + RECT_VERTEX_SHADER: 0x%p\n"
+        "  + RECT_PIXEL_SHADER:  0x%p",
         result.device,
         result.context,
         result.swapChain,
@@ -313,15 +639,513 @@ RendererState RendererInit(HWND window)
         result.vertexShader,
         result.pixelShader,
         result.renderTargetView,
-        result.vertexBuffer);
+        result.vertexBuffer,
+        result.constantBuffer,
+        result.blendState,
+        result.rectInputLayout,
+        result.rectVertexShader,
+        result.rectPixelShader);
 
     return result;
 }
 
+static void RendererCacheFreeRange(RendererCache *cache, u32 page, u32 firstVertex, u32 vertexCount)
+{
+    u32 index = 0;
+    while (index < cache->freeRangeCount &&
+        (cache->freeRanges[index].page < page ||
+        (cache->freeRanges[index].page == page && cache->freeRanges[index].firstVertex < firstVertex)))
+    {
+        ++index;
+    }
+
+    RendererCacheRange *previous = index > 0 ? &cache->freeRanges[index - 1] : nullptr;
+    RendererCacheRange *next = index < cache->freeRangeCount ? &cache->freeRanges[index] : nullptr;
+    bool joinsPrevious = previous && previous->page == page && previous->firstVertex + previous->vertexCount == firstVertex;
+    bool joinsNext = next && next->page == page && firstVertex + vertexCount == next->firstVertex;
+
+    if (joinsPrevious && joinsNext)
+    {
+        previous->vertexCount += vertexCount + next->vertexCount;
+        memmove(next, next + 1, (cache->freeRangeCount - index - 1) * sizeof(RendererCacheRange));
+        --cache->freeRangeCount;
+    }
+    else if (joinsPrevious)
+    {
+        previous->vertexCount += vertexCount;
+    }
+    else if (joinsNext)
+    {
+        next->firstVertex = firstVertex;
+        next->vertexCount += vertexCount;
+    }
+    else
+    {
+        Assert(cache->freeRangeCount < ArrayCount(cache->freeRanges));
+        memmove(&cache->freeRanges[index + 1], &cache->freeRanges[index], (cache->freeRangeCount - index) * sizeof(RendererCacheRange));
+        cache->freeRanges[index] = { .page = page, .firstVertex = firstVertex, .vertexCount = vertexCount };
+        ++cache->freeRangeCount;
+    }
+}
+
+// First fit over the free list. Returns false if no page has a large enough hole.
+static bool RendererCacheAllocRange(RendererCache *cache, u32 vertexCount, u32 *page, u32 *firstVertex)
+{
+    for (u32 i = 0; i < cache->freeRangeCount; ++i)
+    {
+        RendererCacheRange *range = &cache->freeRanges[i];
+        if (range->vertexCount < vertexCount) { continue; }
+
+        *page = range->page;
+        *firstVertex = range->firstVertex;
+        range->firstVertex += vertexCount;
+        range->vertexCount -= vertexCount;
+        if (range->vertexCount == 0)
+        {
+            memmove(range, range + 1, (cache->freeRangeCount - i - 1) * sizeof(RendererCacheRange));
+            --cache->freeRangeCount;
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool RendererCacheAddPage(RendererState *renderer)
+{
+    // NOTE: RENDERER_CACHE_MAX_PAGES only sizes the page array, budgetBytes is the real limit.
+    RendererCache *cache = &renderer->cache;
+    if (cache->pageCount == RENDERER_CACHE_MAX_PAGES) { return false; }
+    if ((u64)(cache->pageCount + 1) * RENDERER_CACHE_PAGE_BYTES > cache->budgetBytes) { return false; }
+
+    D3D11_BUFFER_DESC pageBufferDesc =
+    {
+        .ByteWidth = (UINT)(RENDERER_CACHE_PAGE_VERTICES * sizeof(Vertex)),
+        .Usage = D3D11_USAGE_DEFAULT,
+        .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+    };
+    ID3D11Buffer *page = nullptr;
+    if (FAILED(renderer->device->CreateBuffer(&pageBufferDesc, nullptr, &page)))
+    {
+        LogError("Could not create geometry cache page %u.", cache->pageCount);
+        return false;
+    }
+    LogInfo("Created geometry cache page.\n"
+        "  + PAGE: %u (0x%p)",
+        cache->pageCount, page);
+
+    cache->pages[cache->pageCount] = page;
+    RendererCacheFreeRange(cache, cache->pageCount, 0, (u32)RENDERER_CACHE_PAGE_VERTICES);
+    ++cache->pageCount;
+    return true;
+}
+
+static u32 RendererCacheHash(u64 id)
+{
+    return (u32)((id * 0x9E3779B97F4A7C15ull) >> 32) & (RENDERER_CACHE_INDEX_SLOTS - 1);
+}
+
+// Returns the index slot holding id, or the empty slot where it would be inserted.
+static u32 RendererCacheIndexSlot(const RendererCache *cache, u64 id)
+{
+    u32 slot = RendererCacheHash(id);
+    while (cache->index[slot] && cache->entries[cache->index[slot] - 1].id != id)
+    {
+        slot = (slot + 1) & (RENDERER_CACHE_INDEX_SLOTS - 1);
+    }
+    return slot;
+}
+
+static RendererCacheEntry *RendererCacheFind(RendererCache *cache, u64 id)
+{
+    u32 slot = RendererCacheIndexSlot(cache, id);
+    return cache->index[slot] ? &cache->entries[cache->index[slot] - 1] : nullptr;
+}
+
+static void RendererCacheLruUnlink(RendererCache *cache, u32 entryIndex)
+{
+    RendererCacheEntry *entry = &cache->entries[entryIndex];
+    if (entry->lruPrev) { cache->entries[entry->lruPrev - 1].lruNext = entry->lruNext; }
+    else                { cache->lruOldest = entry->lruNext; }
+    if (entry->lruNext) { cache->entries[entry->lruNext - 1].lruPrev = entry->lruPrev; }
+    else                { cache->lruNewest = entry->lruPrev; }
+    entry->lruPrev = 0;
+    entry->lruNext = 0;
+}
+
+static void RendererCacheLruPushNewest(RendererCache *cache, u32 entryIndex)
+{
+    RendererCacheEntry *entry = &cache->entries[entryIndex];
+    entry->lruPrev = cache->lruNewest;
+    entry->lruNext = 0;
+    if (cache->lruNewest) { cache->entries[cache->lruNewest - 1].lruNext = entryIndex + 1; }
+    else                  { cache->lruOldest = entryIndex + 1; }
+    cache->lruNewest = entryIndex + 1;
+}
+
+static void RendererCacheTouch(RendererCache *cache, RendererCacheEntry *entry)
+{
+    u32 entryIndex = (u32)(entry - cache->entries);
+    entry->lastUsedFrame = cache->frame;
+    RendererCacheLruUnlink(cache, entryIndex);
+    RendererCacheLruPushNewest(cache, entryIndex);
+}
+
+static void RendererCacheRemove(RendererCache *cache, u32 entryIndex)
+{
+    RendererCacheEntry *entry = &cache->entries[entryIndex];
+    RendererCacheFreeRange(cache, entry->page, entry->firstVertex, entry->vertexCount);
+    cache->residentBytes -= (u64)entry->vertexCount * sizeof(Vertex);
+    RendererCacheLruUnlink(cache, entryIndex);
+
+    // Backward shift deletion, so probe chains that ran through this slot stay intact
+    u32 hole = RendererCacheIndexSlot(cache, entry->id);
+    u32 next = (hole + 1) & (RENDERER_CACHE_INDEX_SLOTS - 1);
+    while (cache->index[next])
+    {
+        u32 home = RendererCacheHash(cache->entries[cache->index[next] - 1].id);
+        if (((next - home) & (RENDERER_CACHE_INDEX_SLOTS - 1)) >= ((next - hole) & (RENDERER_CACHE_INDEX_SLOTS - 1)))
+        {
+            cache->index[hole] = cache->index[next];
+            hole = next;
+        }
+        next = (next + 1) & (RENDERER_CACHE_INDEX_SLOTS - 1);
+    }
+    cache->index[hole] = 0;
+
+    // Swap the last entry into the freed slot and repoint everything that refers to it
+    u32 lastIndex = --cache->entryCount;
+    if (entryIndex != lastIndex)
+    {
+        RendererCacheEntry *last = &cache->entries[lastIndex];
+        cache->index[RendererCacheIndexSlot(cache, last->id)] = (u16)(entryIndex + 1);
+        if (last->lruPrev) { cache->entries[last->lruPrev - 1].lruNext = entryIndex + 1; }
+        else               { cache->lruOldest = entryIndex + 1; }
+        if (last->lruNext) { cache->entries[last->lruNext - 1].lruPrev = entryIndex + 1; }
+        else               { cache->lruNewest = entryIndex + 1; }
+        cache->entries[entryIndex] = *last;
+    }
+}
+
+// Evicts the least recently used block, unless that one was already drawn this frame (then
+// every resident block was, since drawn blocks move to the newest end of the list).
+static bool RendererCacheEvictLRU(RendererCache *cache)
+{
+    if (!cache->lruOldest) { return false; }
+    u32 oldest = cache->lruOldest - 1;
+    if (cache->entries[oldest].lastUsedFrame == cache->frame) { return false; }
+
+    RendererCacheRemove(cache, oldest);
+    ++cache->frameStats.evictions;
+    return true;
+}
+
+// Returns the resident range for the block, uploading it only if it is new or its version
+// changed. Returns nullptr if the block cannot be made resident (bigger than a page, or every
+// slot is taken by blocks drawn this frame); the caller draws those through the immediate path.
+static RendererCacheEntry *RendererCacheAcquire(RendererState *renderer, const RendererBlock *block)
+{
+    RendererCache *cache = &renderer->cache;
+    RendererCacheEntry *existing = RendererCacheFind(cache, block->id);
+    if (existing)
+    {
+        if (existing->version == block->version)
+        {
+            RendererCacheTouch(cache, existing);
+            ++cache->frameStats.hits;
+            return existing;
+        }
+        RendererCacheRemove(cache, (u32)(existing - cache->entries));
+    }
+    ++cache->frameStats.misses;
+
+    // NOTE: Blocks drawn this frame are never evicted, so a frame that needs more than the
+    // budget overflows to the immediate path instead of thrashing. The one exception is a
+    // stale version of this same block, which RendererDrawBlocks() has already drawn.
+    u32 page = 0;
+    u32 firstVertex = 0;
+    bool allocated = block->vertexCount <= RENDERER_CACHE_PAGE_VERTICES;
+    if (allocated && cache->entryCount == RENDERER_CACHE_MAX_ENTRIES)
+    {
+        allocated = RendererCacheEvictLRU(cache);
+    }
+    while (allocated && !RendererCacheAllocRange(cache, block->vertexCount, &page, &firstVertex))
+    {
+        allocated = RendererCacheAddPage(renderer) || RendererCacheEvictLRU(cache);
+    }
+    if (!allocated)
+    {
+        ++cache->frameStats.overflows;
+        ++cache->pendingOverflows;
+        return nullptr;
+    }
+
+    D3D11_BOX destination =
+    {
+        .left = firstVertex * (UINT)sizeof(Vertex),
+        .top = 0,
+        .front = 0,
+        .right = (firstVertex + block->vertexCount) * (UINT)sizeof(Vertex),
+        .bottom = 1,
+        .back = 1,
+    };
+    renderer->context->UpdateSubresource(cache->pages[page], 0, &destination, block->vertices, 0, 0);
+
+    u64 bytes = (u64)block->vertexCount * sizeof(Vertex);
+    cache->residentBytes += bytes;
+    cache->frameStats.uploadBytes += bytes;
+    cache->entries[cache->entryCount] =
+    {
+        .id = block->id,
+        .version = block->version,
+        .vertexCount = block->vertexCount,
+        .lastUsedFrame = cache->frame,
+        .page = page,
+        .firstVertex = firstVertex,
+    };
+    u32 entryIndex = cache->entryCount++;
+    cache->index[RendererCacheIndexSlot(cache, block->id)] = (u16)(entryIndex + 1);
+    RendererCacheLruPushNewest(cache, entryIndex);
+    return &cache->entries[entryIndex];
+}
+
+static void RendererCacheReport(RendererCache *cache)
+{
+    u32 lookups = cache->totalStats.hits + cache->totalStats.misses;
+    LogInfo("Geometry cache after %llu frames.\n"
+        "  + ENTRIES:   %u\n"
+        "  + PAGES:     %u\n"
+        "  + RESIDENT:  %llu / %llu bytes\n"
+        "  + HIT_RATE:  %.2f%% (%u hits, %u misses)\n"
+        "  + EVICTIONS: %u\n"
+        "  + OVERFLOWS: %u\n"
+        "  + UPLOADED:  %llu bytes (%llu last frame)",
+        cache->frame,
+        cache->entryCount,
+        cache->pageCount,
+        cache->residentBytes, cache->budgetBytes,
+        lookups ? 100.0 * (double)cache->totalStats.hits / (double)lookups : 0.0,
+        cache->totalStats.hits, cache->totalStats.misses,
+        cache->totalStats.evictions,
+        cache->totalStats.overflows,
+        cache->totalStats.uploadBytes, cache->frameStats.uploadBytes);
+
+    if (cache->pendingOverflows > 0)
+    {
+        LogError("Geometry cache overflowed, %u blocks were drawn through the immediate path.", cache->pendingOverflows);
+        cache->pendingOverflows = 0;
+    }
+}
+
+static void RendererDrawReport(RendererState *renderer)
+{
+    const RendererDrawStats *stats = &renderer->intervalStats;
+    double frames = (double)RENDERER_REPORT_INTERVAL;
+    double cpuMs = renderer->ticksPerSecond
+        ? 1000.0 * (double)stats->cpuTicks / (double)renderer->ticksPerSecond / frames
+        : 0.0;
+    double gpuFrames = stats->gpuFrames ? (double)stats->gpuFrames : 1.0;
+    LogInfo("Draw stats, average over the last %u frames.\n"
+        "  + DRAW_CALLS:   %.1f\n"
+        "  + TRIANGLES:    %.1f\n"
+        "  + RECTS:        %.1f\n"
+        "  + UPLOADED:     %.1f bytes\n"
+        "  + CPU_RECORD:   %.3f ms\n"
+        "  + GPU_BLOCKS:   %.3f ms\n"
+        "  + GPU_RECTS:    %.3f ms\n"
+        "  + GPU_VERTICES: %.3f ms (%u frames sampled)",
+        RENDERER_REPORT_INTERVAL,
+        (double)stats->drawCalls / frames,
+        (double)stats->triangles / frames,
+        (double)stats->rects / frames,
+        (double)stats->uploadBytes / frames,
+        cpuMs,
+        stats->gpuMs[RENDERER_COMMAND_BLOCKS] / gpuFrames,
+        stats->gpuMs[RENDERER_COMMAND_RECTS] / gpuFrames,
+        stats->gpuMs[RENDERER_COMMAND_VERTICES] / gpuFrames,
+        stats->gpuFrames);
+    renderer->intervalStats = {};
+}
+
+void RendererResize(RendererState *renderer, u32 width, u32 height)
+{
+    if (!renderer || !renderer->swapChain || width == 0 || height == 0) { return; }
+
+    renderer->context->OMSetRenderTargets(0, nullptr, nullptr);
+    if (renderer->renderTargetView) { renderer->renderTargetView->Release(); renderer->renderTargetView = nullptr; }
+
+    HRESULT hr = renderer->swapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
+    if (SUCCEEDED(hr))
+    {
+        LogInfo("Resized swapchain buffers to %ux%u.", width, height);
+    }
+    else
+    {
+        LogError("Could not resize swapchain buffers to %ux%u.", width, height);
+    }
+
+    RendererCreateRenderTargetView(renderer);
+}
+
 u32 stride = sizeof(Vertex);
+u32 rectStride = sizeof(RendererRect);
 u32 offset = 0;
+
+// NOTE: The dynamic vertex buffer is used as a ring: appends use NO_OVERWRITE and only a
+// wrap-around DISCARDs, so several immediate draws per frame never stall on each other.
+static void RendererDrawVertices(RendererState *renderer, const Vertex *vertices, u32 vertexCount)
+{
+    if (vertexCount == 0) { return; }
+
+    if (vertexCount > renderer->vertexBufferCapacity)
+    {
+        if (renderer->vertexBuffer) { renderer->vertexBuffer->Release(); renderer->vertexBuffer = nullptr; }
+        u32 capacity = renderer->vertexBufferCapacity * 2;
+        if (capacity < vertexCount) { capacity = vertexCount; }
+        D3D11_BUFFER_DESC vertexBufferDesc
+        {
+            .ByteWidth = (UINT)(capacity * sizeof(Vertex)),
+            .Usage = D3D11_USAGE_DYNAMIC,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE,
+        };
+        if (SUCCEEDED(renderer->device->CreateBuffer(&vertexBufferDesc, nullptr, &renderer->vertexBuffer)))
+        {
+            renderer->vertexBufferCapacity = capacity;
+            renderer->vertexBufferCursor = capacity;
+        }
+        else
+        {
+            LogError("Could not grow vertex buffer to %u vertices.", capacity);
+            renderer->vertexBufferCapacity = 0;
+            renderer->vertexBufferCursor = 0;
+            return;
+        }
+    }
+
+    D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+    if (renderer->vertexBufferCursor + vertexCount > renderer->vertexBufferCapacity)
+    {
+        mapType = D3D11_MAP_WRITE_DISCARD;
+        renderer->vertexBufferCursor = 0;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE vertexData;
+    renderer->context->Map(renderer->vertexBuffer, 0, mapType, 0, &vertexData);
+    memcpy((Vertex *)vertexData.pData + renderer->vertexBufferCursor, vertices, vertexCount * sizeof(Vertex));
+    renderer->context->Unmap(renderer->vertexBuffer, 0);
+
+    renderer->context->IASetVertexBuffers(0, 1, &renderer->vertexBuffer, &stride, &offset);
+    renderer->context->Draw((UINT)vertexCount, (UINT)renderer->vertexBufferCursor);
+    renderer->vertexBufferCursor += vertexCount;
+    renderer->frameStats.uploadBytes += vertexCount * sizeof(Vertex);
+    ++renderer->frameStats.drawCalls;
+    renderer->frameStats.triangles += vertexCount / 3;
+}
+
+// Reads back the oldest frame in flight. If the GPU has not finished it yet the sample is
+// dropped rather than stalling, so gpuFrames can be lower than the frame count.
+static void RendererGpuTimerCollect(RendererState *renderer, RendererGpuTimer *timer)
+{
+    if (!timer->pending) { return; }
+    timer->pending = false;
+
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+    if (renderer->context->GetData(timer->disjoint, &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+        disjoint.Disjoint || disjoint.Frequency == 0)
+    {
+        return;
+    }
+
+    u64 timestamps[RENDERER_GPU_TIMER_MAX_COMMANDS + 1];
+    for (u32 i = 0; i <= timer->commandCount; ++i)
+    {
+        if (renderer->context->GetData(timer->timestamps[i], &timestamps[i], sizeof(u64), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        {
+            return;
+        }
+    }
+    for (u32 i = 0; i < timer->commandCount; ++i)
+    {
+        renderer->intervalStats.gpuMs[timer->commandTypes[i]] +=
+            1000.0 * (double)(timestamps[i + 1] - timestamps[i]) / (double)disjoint.Frequency;
+    }
+    ++renderer->intervalStats.gpuFrames;
+}
+
+static void RendererDrawRects(RendererState *renderer, u32 first, u32 count)
+{
+    if (count == 0 || !renderer->rectBuffer) { return; }
+
+    renderer->context->IASetInputLayout(renderer->rectInputLayout);
+    renderer->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    renderer->context->IASetVertexBuffers(0, 1, &renderer->rectBuffer, &rectStride, &offset);
+    renderer->context->VSSetShader(renderer->rectVertexShader, 0, 0);
+    renderer->context->PSSetShader(renderer->rectPixelShader, 0, 0);
+    renderer->context->DrawInstanced(4, (UINT)count, 0, (UINT)first);
+    ++renderer->frameStats.drawCalls;
+    renderer->frameStats.triangles += 2 * count;
+    renderer->frameStats.rects += count;
+
+    renderer->context->IASetInputLayout(renderer->inputLayout);
+    renderer->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    renderer->context->VSSetShader(renderer->vertexShader, 0, 0);
+    renderer->context->PSSetShader(renderer->pixelShader, 0, 0);
+}
+
+// Draws one run of consecutive resident blocks that sit back to back in the same page.
+static void RendererDrawCachedRun(RendererState *renderer, u32 page, u32 firstVertex, u32 vertexCount)
+{
+    if (vertexCount == 0) { return; }
+
+    renderer->context->IASetVertexBuffers(0, 1, &renderer->cache.pages[page], &stride, &offset);
+    renderer->context->Draw((UINT)vertexCount, (UINT)firstVertex);
+    ++renderer->frameStats.drawCalls;
+    renderer->frameStats.triangles += vertexCount / 3;
+}
+
+static void RendererDrawBlocks(RendererState *renderer, const RendererBlock *blocks, u32 count)
+{
+    // Merged into one draw while consecutive blocks stay contiguous in a page
+    struct { u32 page, firstVertex, vertexCount; } run = {};
+    for (u32 i = 0; i < count; ++i)
+    {
+        const RendererBlock *block = &blocks[i];
+        if (block->vertexCount == 0) { continue; }
+
+        // NOTE: A miss can free a range drawn earlier this frame (the same id submitted again
+        // with a new version) and upload over it, so the pending run is drawn first.
+        RendererCacheEntry *existing = RendererCacheFind(&renderer->cache, block->id);
+        if (!existing || existing->version != block->version)
+        {
+            RendererDrawCachedRun(renderer, run.page, run.firstVertex, run.vertexCount);
+            run = {};
+        }
+
+        RendererCacheEntry *entry = RendererCacheAcquire(renderer, block);
+        if (!entry)
+        {
+            RendererDrawVertices(renderer, block->vertices, block->vertexCount);
+            continue;
+        }
+
+        if (run.vertexCount > 0 && run.page == entry->page && run.firstVertex + run.vertexCount == entry->firstVertex)
+        {
+            run.vertexCount += entry->vertexCount;
+        }
+        else
+        {
+            RendererDrawCachedRun(renderer, run.page, run.firstVertex, run.vertexCount);
+            run = { entry->page, entry->firstVertex, entry->vertexCount };
+        }
+    }
+    RendererDrawCachedRun(renderer, run.page, run.firstVertex, run.vertexCount);
+}
+
 void RendererDraw(RendererState *renderer, const RendererDrawData *drawData)
 {
+    // NOTE: Only missing if a resize failed to recreate it; skip the frame rather than crash.
+    if (!renderer->renderTargetView) { return; }
+
     DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
     renderer->swapChain->GetDesc(&swapChainDesc);
     D3D11_VIEWPORT viewport =
@@ -334,36 +1158,168 @@ void RendererDraw(RendererState *renderer, const RendererDrawData *drawData)
         .MaxDepth = 1
     };
 
-    if (drawData)
-    {
-        if (!renderer->vertexBuffer)
-        {
-            D3D11_BUFFER_DESC vertexBufferDesc
-            {
-                .ByteWidth = (UINT)(drawData->vertexCount * sizeof(Vertex)),
-                .Usage = D3D11_USAGE_DYNAMIC,
-                .BindFlags = D3D11_BIND_VERTEX_BUFFER,
-                .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE,
-            };
-            renderer->device->CreateBuffer(&vertexBufferDesc, nullptr, &renderer->vertexBuffer);
-        }
+    LARGE_INTEGER frameStart = {};
+    QueryPerformanceCounter(&frameStart);
 
-        D3D11_MAPPED_SUBRESOURCE vertexData;
-        renderer->context->Map(renderer->vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &vertexData);
-        Vertex *vertices = (Vertex *)vertexData.pData;
-        memcpy(vertices, drawData->vertices, drawData->vertexCount * sizeof(Vertex));
-        renderer->context->Unmap(renderer->vertexBuffer, 0);
-    }
+    RendererCache *cache = &renderer->cache;
+    ++cache->frame;
+    cache->frameStats = {};
+    renderer->frameStats = {};
 
     renderer->context->IASetInputLayout(renderer->inputLayout);
-    renderer->context->IASetVertexBuffers(0, 1, &renderer->vertexBuffer, &stride, &offset);
     renderer->context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     renderer->context->VSSetShader(renderer->vertexShader, 0, 0);
+    renderer->context->VSSetConstantBuffers(0, 1, &renderer->constantBuffer);
     renderer->context->PSSetShader(renderer->pixelShader, 0, 0);
+    renderer->context->PSSetConstantBuffers(0, 1, &renderer->constantBuffer);
+    renderer->context->OMSetBlendState(renderer->blendState, nullptr, 0xffffffff);
     renderer->context->OMSetRenderTargets(1, &renderer->renderTargetView, 0);
     renderer->context->RSSetViewports(1, &viewport);
 
-    renderer->context->Draw((UINT)drawData->vertexCount, 0);
+    // NOTE: Blending reads the back buffer, which FLIP_DISCARD leaves undefined after Present().
+    const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    renderer->context->ClearRenderTargetView(renderer->renderTargetView, clearColor);
+
+    if (drawData)
+    {
+        // Only re-upload the view when it actually changed (scroll, zoom or resize)
+        float zoom = drawData->view.zoom > 0.0f ? drawData->view.zoom : 1.0f;
+        if (renderer->constants.screenSize.x != viewport.Width  ||
+            renderer->constants.screenSize.y != viewport.Height ||
+            renderer->constants.scroll.x     != drawData->view.scroll.x ||
+            renderer->constants.scroll.y     != drawData->view.scroll.y ||
+            renderer->constants.zoom         != zoom)
+        {
+            renderer->constants.screenSize.x = viewport.Width;
+            renderer->constants.screenSize.y = viewport.Height;
+            renderer->constants.scroll.x     = drawData->view.scroll.x;
+            renderer->constants.scroll.y     = drawData->view.scroll.y;
+            renderer->constants.zoom         = zoom;
+
+            D3D11_MAPPED_SUBRESOURCE constantData;
+            renderer->context->Map(renderer->constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &constantData);
+            memcpy(constantData.pData, &renderer->constants, sizeof(renderer->constants));
+            renderer->context->Unmap(renderer->constantBuffer, 0);
+        }
+
+        // Upload every rect once, commands draw instance ranges out of it
+        if (drawData->rectCount > 0)
+        {
+            if (drawData->rectCount > renderer->rectBufferCapacity)
+            {
+                if (renderer->rectBuffer) { renderer->rectBuffer->Release(); renderer->rectBuffer = nullptr; }
+                u32 capacity = renderer->rectBufferCapacity * 2;
+                if (capacity < drawData->rectCount) { capacity = drawData->rectCount; }
+                D3D11_BUFFER_DESC rectBufferDesc
+                {
+                    .ByteWidth = (UINT)(capacity * sizeof(RendererRect)),
+                    .Usage = D3D11_USAGE_DYNAMIC,
+                    .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+                    .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE,
+                };
+                if (SUCCEEDED(renderer->device->CreateBuffer(&rectBufferDesc, nullptr, &renderer->rectBuffer)))
+                {
+                    renderer->rectBufferCapacity = capacity;
+                }
+                else
+                {
+                    LogError("Could not grow rect buffer to %u rects.", capacity);
+                    renderer->rectBufferCapacity = 0;
+                }
+            }
+
+            if (renderer->rectBuffer)
+            {
+                D3D11_MAPPED_SUBRESOURCE rectData;
+                renderer->context->Map(renderer->rectBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &rectData);
+                memcpy(rectData.pData, drawData->rects, drawData->rectCount * sizeof(RendererRect));
+                renderer->context->Unmap(renderer->rectBuffer, 0);
+                renderer->frameStats.uploadBytes += drawData->rectCount * sizeof(RendererRect);
+            }
+        }
+
+        RendererCommand defaultCommands[] =
+        {
+            { RENDERER_COMMAND_RECTS,    0, drawData->rectCount   },
+            { RENDERER_COMMAND_BLOCKS,   0, drawData->blockCount  },
+            { RENDERER_COMMAND_VERTICES, 0, drawData->vertexCount },
+        };
+        const RendererCommand *commands = drawData->commandCount ? drawData->commands : defaultCommands;
+        u32 commandCount = drawData->commandCount ? drawData->commandCount : (u32)ArrayCount(defaultCommands);
+
+        // NOTE: A timestamp before the first command and after each one, so every command's GPU
+        // time lands on its type. Commands past the timer capacity are drawn but not timed.
+        RendererGpuTimer *timer = &renderer->gpuTimers[cache->frame % RENDERER_GPU_TIMER_FRAMES];
+        RendererGpuTimerCollect(renderer, timer);
+        bool timed = timer->disjoint != nullptr;
+        if (timed)
+        {
+            timer->commandCount = 0;
+            renderer->context->Begin(timer->disjoint);
+            renderer->context->End(timer->timestamps[0]);
+        }
+
+        for (u32 i = 0; i < commandCount; ++i)
+        {
+            const RendererCommand *command = &commands[i];
+            switch (command->type)
+            {
+                case RENDERER_COMMAND_BLOCKS:
+                {
+                    Assert(command->first + command->count <= drawData->blockCount);
+                    RendererDrawBlocks(renderer, drawData->blocks + command->first, command->count);
+                } break;
+
+                case RENDERER_COMMAND_RECTS:
+                {
+                    Assert(command->first + command->count <= drawData->rectCount);
+                    RendererDrawRects(renderer, command->first, command->count);
+                } break;
+
+                case RENDERER_COMMAND_VERTICES:
+                {
+                    Assert(command->first + command->count <= drawData->vertexCount);
+                    RendererDrawVertices(renderer, drawData->vertices + command->first, command->count);
+                } break;
+
+                default: Assert(false); break;
+            }
+
+            if (timed && timer->commandCount < RENDERER_GPU_TIMER_MAX_COMMANDS)
+            {
+                timer->commandTypes[timer->commandCount] = command->type;
+                renderer->context->End(timer->timestamps[++timer->commandCount]);
+            }
+        }
+
+        if (timed)
+        {
+            renderer->context->End(timer->disjoint);
+            timer->pending = true;
+        }
+    }
+
+    cache->totalStats.hits        += cache->frameStats.hits;
+    cache->totalStats.misses      += cache->frameStats.misses;
+    cache->totalStats.evictions   += cache->frameStats.evictions;
+    cache->totalStats.overflows   += cache->frameStats.overflows;
+    cache->totalStats.uploadBytes += cache->frameStats.uploadBytes;
+
+    // NOTE: CPU time stops before Present() so vsync does not hide the cost of recording.
+    LARGE_INTEGER frameEnd = {};
+    QueryPerformanceCounter(&frameEnd);
+    renderer->frameStats.cpuTicks = (u64)(frameEnd.QuadPart - frameStart.QuadPart);
+    renderer->intervalStats.drawCalls += renderer->frameStats.drawCalls;
+    renderer->intervalStats.triangles += renderer->frameStats.triangles;
+    renderer->intervalStats.rects     += renderer->frameStats.rects;
+    renderer->intervalStats.cpuTicks  += renderer->frameStats.cpuTicks;
+    renderer->intervalStats.uploadBytes += renderer->frameStats.uploadBytes;
+
+    if (cache->frame % RENDERER_REPORT_INTERVAL == 0)
+    {
+        RendererCacheReport(cache);
+        RendererDrawReport(renderer);
+    }
 
     renderer->swapChain->Present(1, 0);
 }
@@ -380,5 +1336,26 @@ void RendererCleanup(RendererState *renderer)
         if (renderer->pixelShader)          { renderer->pixelShader         ->Release(); renderer->pixelShader          = nullptr; }
         if (renderer->renderTargetView)     { renderer->renderTargetView    ->Release(); renderer->renderTargetView     = nullptr; }
         if (renderer->vertexBuffer)         { renderer->vertexBuffer        ->Release(); renderer->vertexBuffer         = nullptr; }
+        if (renderer->constantBuffer)       { renderer->constantBuffer      ->Release(); renderer->constantBuffer       = nullptr; }
+        if (renderer->blendState)           { renderer->blendState          ->Release(); renderer->blendState           = nullptr; }
+        if (renderer->rectInputLayout)      { renderer->rectInputLayout     ->Release(); renderer->rectInputLayout      = nullptr; }
+        if (renderer->rectVertexShader)     { renderer->rectVertexShader    ->Release(); renderer->rectVertexShader     = nullptr; }
+        if (renderer->rectPixelShader)      { renderer->rectPixelShader     ->Release(); renderer->rectPixelShader      = nullptr; }
+        if (renderer->rectBuffer)           { renderer->rectBuffer          ->Release(); renderer->rectBuffer           = nullptr; }
+        for (u32 i = 0; i < RENDERER_GPU_TIMER_FRAMES; ++i)
+        {
+            RendererGpuTimer *timer = &renderer->gpuTimers[i];
+            if (timer->disjoint) { timer->disjoint->Release(); timer->disjoint = nullptr; }
+            for (u32 j = 0; j < ArrayCount(timer->timestamps); ++j)
+            {
+                if (timer->timestamps[j]) { timer->timestamps[j]->Release(); timer->timestamps[j] = nullptr; }
+            }
+        }
+        for (u32 i = 0; i < renderer->cache.pageCount; ++i)
+        {
+            renderer->cache.pages[i]->Release();
+            renderer->cache.pages[i] = nullptr;
+        }
+        ZeroMemory(&renderer->cache, sizeof(renderer->cache));
     }
 }
\ No newline at end of file
@@ -1,5 +1,107 @@
 #pragma once
 
+#define RENDERER_CACHE_MAX_ENTRIES      1024
+#define RENDERER_CACHE_INDEX_SLOTS      (2 * RENDERER_CACHE_MAX_ENTRIES)
+#define RENDERER_CACHE_BUDGET_BYTES     (16 * 1024 * 1024)
+#define RENDERER_CACHE_PAGE_BYTES       (1024 * 1024)
+#define RENDERER_CACHE_PAGE_VERTICES    (RENDERER_CACHE_PAGE_BYTES / sizeof(Vertex))
+#define RENDERER_CACHE_MAX_PAGES        (RENDERER_CACHE_BUDGET_BYTES / RENDERER_CACHE_PAGE_BYTES)
+#define RENDERER_REPORT_INTERVAL        600
+#define RENDERER_GPU_TIMER_FRAMES       3
+#define RENDERER_GPU_TIMER_MAX_COMMANDS 32
+
+// NOTE: One resident block of retained geometry, living at firstVertex in one of the
+// cache pages. A new version frees the range and uploads into a fresh one. lruPrev and
+// lruNext link the entry into the LRU list as slot + 1.
+typedef struct
+{
+    u64 id;
+    u32 version;
+    u32 vertexCount;
+    u64 lastUsedFrame;
+    u32 page;
+    u32 firstVertex;
+    u32 lruPrev;
+    u32 lruNext;
+} RendererCacheEntry;
+
+// NOTE: Free vertex range inside a page. The free list is kept sorted by (page, firstVertex)
+// and adjacent ranges are merged, so it never holds more than entries + pages ranges.
+typedef struct
+{
+    u32 page;
+    u32 firstVertex;
+    u32 vertexCount;
+} RendererCacheRange;
+
+typedef struct
+{
+    u32 hits;
+    u32 misses;
+    u32 evictions;
+    u32 overflows;
+    u64 uploadBytes;
+} RendererCacheStats;
+
+typedef struct
+{
+    RendererCacheEntry entries[RENDERER_CACHE_MAX_ENTRIES];
+    u32 entryCount;
+
+    // NOTE: Open addressed (linear probing) map from block id to entry slot, and a list of
+    // entries from least to most recently used. Both store slot + 1 so zero means empty.
+    u16 index[RENDERER_CACHE_INDEX_SLOTS];
+    u32 lruOldest;
+    u32 lruNewest;
+
+    struct ID3D11Buffer *pages[RENDERER_CACHE_MAX_PAGES];
+    u32 pageCount;
+    RendererCacheRange freeRanges[RENDERER_CACHE_MAX_ENTRIES + RENDERER_CACHE_MAX_PAGES];
+    u32 freeRangeCount;
+    u64 residentBytes;
+    u64 budgetBytes;
+    u64 frame;
+    RendererCacheStats frameStats;
+    RendererCacheStats totalStats;
+
+    // NOTE: Blocks drawn through the immediate path since the last report, logged once there.
+    u32 pendingOverflows;
+} RendererCache;
+
+typedef enum
+{
+    RENDERER_COMMAND_BLOCKS,
+    RENDERER_COMMAND_RECTS,
+    RENDERER_COMMAND_VERTICES,
+    RENDERER_COMMAND_TYPE_COUNT,
+} RendererCommandType;
+
+typedef struct
+{
+    u32 drawCalls;
+    u64 triangles;
+    u64 rects;
+    u64 cpuTicks;
+
+    // NOTE: Rect instances, immediate vertices and blocks that overflowed the cache. Cached
+    // block uploads are counted by RendererCache instead.
+    u64 uploadBytes;
+
+    // NOTE: GPU time per command type, from timestamp queries read back a couple of frames
+    // late. gpuFrames counts the frames that produced a valid (non disjoint) sample.
+    double gpuMs[RENDERER_COMMAND_TYPE_COUNT];
+    u32 gpuFrames;
+} RendererDrawStats;
+
+typedef struct
+{
+    struct ID3D11Query *disjoint;
+    struct ID3D11Query *timestamps[RENDERER_GPU_TIMER_MAX_COMMANDS + 1];
+    RendererCommandType commandTypes[RENDERER_GPU_TIMER_MAX_COMMANDS];
+    u32 commandCount;
+    bool pending;
+} RendererGpuTimer;
+
 typedef struct
 {
     struct ID3D11Device           *device;
@@ -10,6 +112,32 @@ typedef struct
     struct ID3D11PixelShader      *pixelShader;
     struct ID3D11RenderTargetView *renderTargetView;
     struct ID3D11Buffer           *vertexBuffer;
+    struct ID3D11Buffer           *constantBuffer;
+    struct ID3D11BlendState       *blendState;
+    struct ID3D11InputLayout      *rectInputLayout;
+    struct ID3D11VertexShader     *rectVertexShader;
+    struct ID3D11PixelShader      *rectPixelShader;
+    struct ID3D11Buffer           *rectBuffer;
+    u32                            vertexBufferCapacity;
+    u32                            vertexBufferCursor;
+    u32                            rectBufferCapacity;
+
+    // NOTE: Last values written to constantBuffer, so unchanged views skip the Map().
+    struct
+    {
+        struct { float x, y; } screenSize;
+        struct { float x, y; } scroll;
+        float zoom;
+        float _pad[3];
+    } constants;
+
+    RendererCache cache;
+
+    // NOTE: intervalStats is reset after every report, so it averages over the last interval.
+    RendererDrawStats frameStats;
+    RendererDrawStats intervalStats;
+    u64 ticksPerSecond;
+    RendererGpuTimer gpuTimers[RENDERER_GPU_TIMER_FRAMES];
 } RendererState;
 
 typedef struct
@@ -18,12 +146,71 @@ typedef struct
     u32 col;
 } Vertex;
 
+// NOTE: Vertices are authored in pixel space (origin top-left, y down). The view is
+// applied in the vertex shader, so panning and zooming only touch the constant buffer.
+typedef struct
+{
+    struct { float x, y; } scroll;
+    float zoom;
+} RendererView;
+
+// NOTE: Geometry that rarely changes (chrome, panels, laid out rows). Keep the id stable
+// and bump the version whenever the vertices change; unchanged blocks are not re-uploaded.
+typedef struct
+{
+    u64 id;
+    u32 version;
+    u32 vertexCount;
+    Vertex *vertices;
+} RendererBlock;
+
+// NOTE: A rounded, bordered, anti-aliased box with an optional drop shadow, shaded from a
+// signed distance field. Drawn as one instanced quad (four vertices) instead of tessellated
+// corners. Colors are AABBGGRR like Vertex::col; a zero shadow alpha disables the shadow.
+typedef struct
+{
+    struct { float x, y, w, h; } rect;
+    float radius;
+    float borderWidth;
+    u32 fillColor;
+    u32 borderColor;
+    u32 shadowColor;
+    float shadowSoftness;
+    struct { float x, y; } shadowOffset;
+} RendererRect;
+
+// NOTE: Draws [first, first + count) of the blocks, rects or vertices array of the
+// RendererDrawData, in command order.
+typedef struct
+{
+    RendererCommandType type;
+    u32 first;
+    u32 count;
+} RendererCommand;
+
 typedef struct
 {
+    // Retained geometry, only re-uploaded when a block's version changes
+    u32 blockCount;
+    RendererBlock *blocks;
+
+    // SDF boxes, uploaded every frame
+    u32 rectCount;
+    RendererRect *rects;
+
+    // Immediate geometry, uploaded every frame
     u32 vertexCount;
     Vertex *vertices;
+
+    // Draw order. Without commands everything is drawn as rects, then blocks, then vertices,
+    // so SDF panels and row backgrounds sit behind the retained content.
+    u32 commandCount;
+    RendererCommand *commands;
+
+    RendererView view;
 } RendererDrawData;
 
 RendererState RendererInit(HWND window);
+void RendererResize(RendererState *renderer, u32 width, u32 height);
 void RendererDraw(RendererState *renderer, const RendererDrawData *drawData);
-void RendererCleanup(RendererState *renderer);
\ No newline at end of file
+void RendererCleanup(RendererState *renderer);